@@ -0,0 +1,221 @@
+#ifndef SQUID_COMPACTDAWG_H_
+#define SQUID_COMPACTDAWG_H_
+
+#include "CompactStaticTrie.h"
+#include "CompactTrie.h"
+#include "CompactValueArray.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/** Static minimized trie (Directed Acyclic Word Graph)
+ *
+ * Read-only counterpart of CompactTrie where identical subtrees, i.e.
+ * subtrees with the same edge labels and the same mapped values, are
+ * stored only once. Tries whose keys share suffixes (forward-order URL
+ * lists, or sets where all values are equal) shrink considerably.
+ *
+ * As nodes are shared among many keys, the keys themselves are not
+ * stored: lookups return a pointer to the mapped value rather than an
+ * iterator. Key characters are treated as unsigned bytes. Mapped values
+ * must be comparable with operator== and hashable with Hash.
+ *
+ * \sa http://en.wikipedia.org/wiki/Deterministic_acyclic_finite_state_automaton
+ */
+template <class Key, class Value, class Hash = std::hash<Value> >
+class CompactDawg
+{
+public:
+    typedef Key key_type;
+    typedef Value mapped_type;
+
+    /// build from the current contents of a CompactTrie
+    explicit CompactDawg(CompactTrie<key_type, mapped_type> &t);
+
+    /// check for key or prefix presence, see CompactTrie::has()
+    bool has(const key_type &k, bool const prefix = false) const {
+        return (prefix ? prefixFind(k) : find(k)) != nullptr;
+    }
+
+    /** key lookup
+     *
+     * \return pointer to the value mapped to key k, or nullptr if not found
+     */
+    const mapped_type *find(const key_type &k) const {
+        return value(CompactStaticTrie::lowFind(*this, root, k.begin(), k.end(), false, false, 0));
+    }
+
+    /** prefix lookup
+     *
+     * \return pointer to the value mapped to the shortest prefix of k,
+     *   or nullptr if no prefix of k is stored
+     */
+    const mapped_type *prefixFind(const key_type &k) const {
+        return value(CompactStaticTrie::lowFind(*this, root, k.begin(), k.end(), true, false, 0));
+    }
+
+    /** constrained prefix lookup
+     *
+     * Same semantics as CompactTrie::prefixFind(key, suffixChar)
+     * \return pointer to the mapped value or nullptr if not found
+     */
+    const mapped_type *prefixFind(const key_type &k, int suffixChar) const {
+        return value(CompactStaticTrie::lowFind(*this, root, k.begin(), k.end(), true, true, suffixChar));
+    }
+
+    /// number of nodes in the source trie
+    size_t trieNodes() const { return sourceNodes; }
+
+    /// number of nodes after minimization
+    size_t nodes() const { return nodeTable.size(); }
+
+    /// number of edges after minimization
+    size_t edges() const { return edgeTable.size(); }
+
+    /// number of distinct mapped values
+    size_t distinctValues() const { return values.size(); }
+
+private:
+    friend class CompactStaticTrie;
+
+    static const uint32_t npos = static_cast<uint32_t>(-1);
+
+    struct Node {
+        uint32_t firstEdge;
+        uint32_t edgeCount;
+        uint32_t value; // index into values, or npos
+    };
+    struct Edge {
+        unsigned char label;
+        uint32_t target;
+    };
+
+    /// node identity while building: value index, then (label, child) pairs
+    typedef std::vector<uint32_t> signature_type;
+    struct SignatureHash {
+        size_t operator()(const signature_type &s) const {
+            uint64_t h = 14695981039346656037ULL;
+            for (auto i = s.begin(); i != s.end(); ++i) {
+                h ^= *i;
+                h *= 1099511628211ULL;
+            }
+            return h;
+        }
+    };
+    struct Builder {
+        std::vector<CompactStaticTrie::key_entry> keys; // see CompactStaticTrie::sortKeys()
+        std::vector<mapped_type> input;
+        std::unordered_map<signature_type, uint32_t, SignatureHash> nodes;
+        std::unordered_map<mapped_type, uint32_t, Hash> values;
+    };
+
+    /** post-order walk of the trie node holding keys [b, e), which share
+     * their first depth characters
+     * \return the id of the equivalent minimized node
+     */
+    uint32_t minimize(Builder &bld, size_t b, size_t e, size_t depth);
+
+    /// child of node reached via character, or npos
+    uint32_t child(uint32_t node, unsigned char character) const;
+
+    bool isTerminal(uint32_t node) const { return nodeTable[node].value != npos; }
+
+    const mapped_type *value(uint32_t node) const {
+        if (node == npos)
+            return nullptr;
+        return &values[nodeTable[node].value];
+    }
+
+    std::vector<Node> nodeTable;
+    std::vector<Edge> edgeTable; // each node's edges are contiguous and sorted by label
+    CompactValueArray<mapped_type> values;
+    uint32_t root;
+    size_t sourceNodes;
+};
+
+template <class Key, class Value, class Hash>
+const uint32_t CompactDawg<Key,Value,Hash>::npos;
+
+template <class Key, class Value, class Hash>
+CompactDawg<Key,Value,Hash>::CompactDawg(CompactTrie<key_type, mapped_type> &t) :
+        root(npos),
+        sourceNodes(0)
+{
+    Builder bld;
+    CompactStaticTrie::sortKeys(t, bld.keys, bld.input);
+    root = minimize(bld, 0, bld.keys.size(), 0);
+    nodeTable.shrink_to_fit();
+    edgeTable.shrink_to_fit();
+    values.shrink_to_fit();
+}
+
+template <class Key, class Value, class Hash>
+uint32_t
+CompactDawg<Key,Value,Hash>::minimize(Builder &bld, size_t b, size_t e, size_t depth)
+{
+    ++sourceNodes;
+    signature_type sig;
+    // sorted input: a key ending at this node comes first
+    if (b < e && bld.keys[b].first.size() == depth) {
+        const mapped_type &data = bld.input[bld.keys[b].second];
+        auto v = bld.values.find(data);
+        if (v == bld.values.end()) {
+            v = bld.values.insert(std::make_pair(data, static_cast<uint32_t>(values.size()))).first;
+            values.push_back(data);
+        }
+        sig.push_back(v->second);
+        ++b;
+    } else {
+        sig.push_back(npos);
+    }
+    while (b < e) {
+        const unsigned char c = bld.keys[b].first[depth];
+        size_t k = b + 1;
+        while (k < e && static_cast<unsigned char>(bld.keys[k].first[depth]) == c)
+            ++k;
+        sig.push_back(c);
+        sig.push_back(minimize(bld, b, k, depth + 1));
+        b = k;
+    }
+
+    const auto found = bld.nodes.find(sig);
+    if (found != bld.nodes.end())
+        return found->second;
+
+    Node node;
+    node.value = sig[0];
+    node.firstEdge = edgeTable.size();
+    node.edgeCount = (sig.size() - 1) / 2;
+    for (size_t i = 1; i < sig.size(); i += 2) {
+        Edge edge;
+        edge.label = sig[i];
+        edge.target = sig[i + 1];
+        edgeTable.push_back(edge);
+    }
+    const uint32_t id = nodeTable.size();
+    nodeTable.push_back(node);
+    bld.nodes.insert(std::make_pair(sig, id));
+    return id;
+}
+
+template <class Key, class Value, class Hash>
+uint32_t
+CompactDawg<Key,Value,Hash>::child(uint32_t node, unsigned char character) const
+{
+    const Node &n = nodeTable[node];
+    const auto begin = edgeTable.begin() + n.firstEdge;
+    const auto end = begin + n.edgeCount;
+    const auto e = std::lower_bound(begin, end, character,
+    [](const Edge &edge, unsigned char c) {
+        return edge.label < c;
+    });
+    if (e == end || e->label != character)
+        return npos;
+    return e->target;
+}
+
+#endif /* SQUID_COMPACTDAWG_H_ */
@@ -0,0 +1,423 @@
+#ifndef SQUID_COMPACTIPTRIE_H_
+#define SQUID_COMPACTIPTRIE_H_
+
+#include <arpa/inet.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+/** Longest-prefix-match container for IPv4 and IPv6 CIDR prefixes
+ *
+ * Prefixes are kept in a plain list and compiled on demand into a
+ * poptrie-like lookup structure: a 65536-entry direct-pointing table
+ * indexed by the first 16 bits of the address, then 256-ary nodes each
+ * consuming 8 more bits. Like in CompactArrayTrieNode, a node is indexed
+ * directly by the next chunk of the key, but its children and leaves are
+ * not stored as sparse arrays: two 256-bit bitmaps record which slots hold
+ * a child node and where runs of identical leaves start, and popcount over
+ * them gives the offset into contiguous child and leaf arrays.
+ * Prefixes are pushed down to the leaves at compile time, so a lookup
+ * never backtracks: one load for the direct-pointing table, one per node
+ * traversed and one for the final leaf. That is at most 4 loads for IPv4,
+ * and 6 for IPv6 addresses covered by prefixes up to /48.
+ *
+ * IPv4 and IPv6 prefixes are kept in separate tables; an IPv4 lookup
+ * never matches an IPv6 prefix and vice versa.
+ * Addresses are passed as byte arrays in network order.
+ */
+template <class Value>
+class CompactIpTrie
+{
+public:
+    typedef Value mapped_type;
+
+    CompactIpTrie() {}
+
+    /** add a prefix to the container
+     *
+     * Any preexisting value for the same prefix gets replaced.
+     * \param addr address bytes in network order; bits past prefixLen are ignored
+     * \param addrLen 4 for IPv4, 16 for IPv6
+     * \param prefixLen number of significant leading bits of addr
+     * \return false if the address family or prefix length are invalid
+     */
+    bool insert(const unsigned char *addr, unsigned int addrLen, unsigned int prefixLen, const mapped_type &v) {
+        if (addrLen == 4)
+            return table4.insert(addr, prefixLen, v);
+        if (addrLen == 16)
+            return table6.insert(addr, prefixLen, v);
+        return false;
+    }
+
+    /** add a prefix in textual CIDR notation
+     *
+     * Accepts "a.b.c.d/len", "x:y::z/len", or a bare address
+     * (treated as a host prefix).
+     * \return false if the string cannot be parsed
+     */
+    bool insert(const std::string &cidr, const mapped_type &v);
+
+    /** longest prefix match
+     *
+     * Compiles the lookup structure first if prefixes were inserted
+     * since the last lookup.
+     * \param addr address bytes in network order
+     * \param addrLen 4 for IPv4, 16 for IPv6
+     * \return pointer to the value associated to the longest stored prefix
+     *  matching addr, or nullptr if no stored prefix matches. The pointer is
+     *  valid until the next insert.
+     */
+    const mapped_type *longestMatch(const unsigned char *addr, unsigned int addrLen) {
+        if (addrLen == 4)
+            return table4.longestMatch(addr);
+        if (addrLen == 16)
+            return table6.longestMatch(addr);
+        return nullptr;
+    }
+
+    /// longest prefix match on an address in textual notation
+    const mapped_type *longestMatch(const std::string &address);
+
+    /** build the lookup structure
+     *
+     * Called implicitly by the first lookup following an insert; call it
+     * explicitly before sharing the container among reader threads.
+     */
+    void compile() {
+        table4.compile();
+        table6.compile();
+    }
+
+    /// true if no prefix was ever inserted
+    bool empty() const {
+        return table4.empty() && table6.empty();
+    }
+
+    /// memory used, in bytes, including the prefix list
+    size_t bytes() const {
+        return sizeof(*this) + table4.heapBytes() + table6.heapBytes();
+    }
+
+private:
+    /// lookup structure and prefix list for one address family
+    template <unsigned int AddrLen>
+    class Table
+    {
+    public:
+        Table() : dirty(false) {}
+
+        bool insert(const unsigned char *addr, unsigned int prefixLen, const mapped_type &v);
+        const mapped_type *longestMatch(const unsigned char *addr) {
+            if (dirty)
+                compile();
+            const uint32_t leaf = lookup(addr);
+            return leaf ? &routes[leaf - 1].value : nullptr;
+        }
+        void compile();
+        bool empty() const { return routes.empty(); }
+        size_t heapBytes() const {
+            return routes.capacity() * sizeof(Route) + root.capacity() * sizeof(uint32_t) +
+                   nodes.capacity() * sizeof(Node) + leaves.capacity() * sizeof(uint32_t);
+        }
+
+    private:
+        static const unsigned int addrBits = AddrLen * 8;
+        static const unsigned int rootStride = 16;
+        static const unsigned int stride = 8;
+        /// entry flag: the low bits are a node index rather than a leaf
+        static const uint32_t nodeFlag = 0x80000000U;
+
+        struct Route {
+            unsigned char addr[AddrLen]; // masked to len bits
+            uint8_t len;
+            mapped_type value;
+        };
+
+        /* 256-ary node. Slot i holds a child if bit i of child is set;
+         * the child is nodes[childBase + number of children before i].
+         * Otherwise it holds a leaf: bit i of leaf is set where a run of
+         * identical leaves (skipping child slots) starts, and the leaf is
+         * leaves[leafBase + number of runs started up to and including i - 1].
+         * Leaves are 1 + index into routes, or 0 for no match.
+         */
+        struct Node {
+            uint64_t child[4];
+            uint64_t leaf[4];
+            uint32_t childBase;
+            uint32_t leafBase;
+        };
+
+        static bool routeLess(const Route &a, const Route &b) {
+            const int c = memcmp(a.addr, b.addr, AddrLen);
+            return c < 0 || (c == 0 && a.len < b.len);
+        }
+        static bool sameRoute(const Route &a, const Route &b) {
+            return a.len == b.len && memcmp(a.addr, b.addr, AddrLen) == 0;
+        }
+
+        uint32_t lookup(const unsigned char *addr) const;
+        void fillNode(uint32_t nodeIdx, size_t b, size_t e, unsigned int consumed, uint32_t inherited);
+
+        std::vector<Route> routes; // sorted and unique unless dirty
+        std::vector<uint32_t> root; // 1 << rootStride entries, node or leaf
+        std::vector<Node> nodes;
+        std::vector<uint32_t> leaves;
+        bool dirty;
+    };
+
+    static bool parse(const std::string &text, unsigned char *addr, unsigned int &addrLen, unsigned int &prefixLen);
+
+    Table<4> table4;
+    Table<16> table6;
+
+    /// not implemented
+    CompactIpTrie(const CompactIpTrie&);
+    /// not implemented
+    CompactIpTrie& operator =(CompactIpTrie const &);
+};
+
+template <class Value>
+template <unsigned int AddrLen>
+bool
+CompactIpTrie<Value>::Table<AddrLen>::insert(const unsigned char *addr, unsigned int prefixLen, const mapped_type &v)
+{
+    if (prefixLen > addrBits)
+        return false;
+    Route r;
+    memset(r.addr, 0, AddrLen);
+    memcpy(r.addr, addr, (prefixLen + 7) / 8);
+    if (prefixLen % 8)
+        r.addr[prefixLen / 8] &= 0xff << (8 - prefixLen % 8);
+    r.len = prefixLen;
+    r.value = v;
+    routes.push_back(r);
+    dirty = true;
+    return true;
+}
+
+template <class Value>
+template <unsigned int AddrLen>
+uint32_t
+CompactIpTrie<Value>::Table<AddrLen>::lookup(const unsigned char *addr) const
+{
+    if (root.empty())
+        return 0;
+    uint32_t e = root[(addr[0] << 8) | addr[1]];
+    unsigned int byte = rootStride / 8;
+    while (e & nodeFlag) {
+        const Node &n = nodes[e & ~nodeFlag];
+        const unsigned int i = addr[byte++];
+        const unsigned int w = i / 64;
+        const uint64_t bit = uint64_t(1) << (i % 64);
+        unsigned int rank = 0;
+        if (n.child[w] & bit) {
+            for (unsigned int j = 0; j < w; ++j)
+                rank += __builtin_popcountll(n.child[j]);
+            rank += __builtin_popcountll(n.child[w] & (bit - 1));
+            e = nodeFlag | (n.childBase + rank);
+        } else {
+            for (unsigned int j = 0; j < w; ++j)
+                rank += __builtin_popcountll(n.leaf[j]);
+            rank += __builtin_popcountll(n.leaf[w] & (bit | (bit - 1)));
+            e = leaves[n.leafBase + rank - 1];
+        }
+    }
+    return e;
+}
+
+template <class Value>
+template <unsigned int AddrLen>
+void
+CompactIpTrie<Value>::Table<AddrLen>::compile()
+{
+    dirty = false;
+
+    // sort, keeping the last inserted value for repeated prefixes
+    std::stable_sort(routes.begin(), routes.end(), routeLess);
+    size_t out = 0;
+    for (size_t i = 0; i < routes.size(); ++i) {
+        if (out && sameRoute(routes[out - 1], routes[i]))
+            routes[out - 1] = routes[i];
+        else
+            routes[out++] = routes[i];
+    }
+    routes.resize(out);
+    routes.shrink_to_fit();
+
+    nodes.clear();
+    leaves.clear();
+    if (routes.empty()) {
+        std::vector<uint32_t>().swap(root);
+        return;
+    }
+    root.assign(1U << rootStride, 0);
+
+    // push prefixes up to rootStride bits into the direct-pointing table
+    std::vector<uint8_t> rootLen(1U << rootStride, 0);
+    for (size_t j = 0; j < routes.size(); ++j) {
+        const Route &r = routes[j];
+        if (r.len > rootStride)
+            continue;
+        const unsigned int first = (r.addr[0] << 8) | r.addr[1];
+        const unsigned int last = first + (1U << (rootStride - r.len));
+        for (unsigned int i = first; i < last; ++i) {
+            if (!root[i] || rootLen[i] <= r.len) {
+                root[i] = j + 1;
+                rootLen[i] = r.len;
+            }
+        }
+    }
+
+    // longer prefixes sharing the same first rootStride bits are contiguous
+    for (size_t b = 0; b < routes.size();) {
+        const unsigned int i = (routes[b].addr[0] << 8) | routes[b].addr[1];
+        size_t e = b;
+        bool deeper = false;
+        while (e < routes.size()) {
+            const unsigned int slot = (routes[e].addr[0] << 8) | routes[e].addr[1];
+            if (slot != i)
+                break;
+            deeper = deeper || routes[e].len > rootStride;
+            ++e;
+        }
+        if (deeper) {
+            const uint32_t nodeIdx = nodes.size();
+            nodes.resize(nodes.size() + 1);
+            const uint32_t inherited = root[i];
+            root[i] = nodeFlag | nodeIdx;
+            fillNode(nodeIdx, b, e, rootStride, inherited);
+        }
+        b = e;
+    }
+    nodes.shrink_to_fit();
+    leaves.shrink_to_fit();
+}
+
+/* Build node nodeIdx for the routes in [b, e), which share their first
+ * consumed bits; routes not longer than consumed were already accounted for
+ * by the parent, which passes the resulting leaf as inherited.
+ */
+template <class Value>
+template <unsigned int AddrLen>
+void
+CompactIpTrie<Value>::Table<AddrLen>::fillNode(uint32_t nodeIdx, size_t b, size_t e, unsigned int consumed, uint32_t inherited)
+{
+    const unsigned int byte = consumed / 8;
+    uint32_t slot[256];
+    uint8_t slotLen[256];
+    std::fill(slot, slot + 256, inherited);
+    std::fill(slotLen, slotLen + 256, 0);
+
+    // leaf pushing: expand prefixes ending within this node over their slots
+    for (size_t j = b; j < e; ++j) {
+        const Route &r = routes[j];
+        if (r.len <= consumed || r.len > consumed + stride)
+            continue;
+        const unsigned int first = r.addr[byte];
+        const unsigned int last = first + (1U << (consumed + stride - r.len));
+        for (unsigned int i = first; i < last; ++i) {
+            if (slotLen[i] <= r.len) {
+                slot[i] = j + 1;
+                slotLen[i] = r.len;
+            }
+        }
+    }
+
+    // slots needing a child node, with their range of routes
+    struct Group {
+        unsigned int slot;
+        size_t b, e;
+    };
+    std::vector<Group> groups;
+    Node n;
+    memset(&n, 0, sizeof(n));
+    for (size_t j = b; j < e;) {
+        const unsigned int i = routes[j].addr[byte];
+        size_t k = j;
+        bool deeper = false;
+        while (k < e && routes[k].addr[byte] == i) {
+            deeper = deeper || routes[k].len > consumed + stride;
+            ++k;
+        }
+        if (deeper) {
+            Group g = { i, j, k };
+            groups.push_back(g);
+            n.child[i / 64] |= uint64_t(1) << (i % 64);
+        }
+        j = k;
+    }
+
+    // run-length compress the leaves, skipping child slots
+    n.leafBase = leaves.size();
+    bool haveLeaf = false;
+    uint32_t previous = 0;
+    for (unsigned int i = 0; i < 256; ++i) {
+        if (n.child[i / 64] & (uint64_t(1) << (i % 64)))
+            continue;
+        if (!haveLeaf || slot[i] != previous) {
+            n.leaf[i / 64] |= uint64_t(1) << (i % 64);
+            leaves.push_back(slot[i]);
+            previous = slot[i];
+            haveLeaf = true;
+        }
+    }
+
+    // children must be contiguous
+    n.childBase = nodes.size();
+    nodes.resize(nodes.size() + groups.size());
+    nodes[nodeIdx] = n;
+    for (size_t g = 0; g < groups.size(); ++g)
+        fillNode(n.childBase + g, groups[g].b, groups[g].e, consumed + stride, slot[groups[g].slot]);
+}
+
+template <class Value>
+bool
+CompactIpTrie<Value>::parse(const std::string &text, unsigned char *addr, unsigned int &addrLen, unsigned int &prefixLen)
+{
+    const std::string::size_type slash = text.find('/');
+    const std::string host = text.substr(0, slash);
+    if (inet_pton(AF_INET, host.c_str(), addr) == 1)
+        addrLen = 4;
+    else if (inet_pton(AF_INET6, host.c_str(), addr) == 1)
+        addrLen = 16;
+    else
+        return false;
+
+    prefixLen = addrLen * 8;
+    if (slash != std::string::npos) {
+        const char *lenStr = text.c_str() + slash + 1;
+        char *endp = nullptr;
+        const unsigned long len = strtoul(lenStr, &endp, 10);
+        if (endp == lenStr || *endp != '\0' || len > prefixLen)
+            return false;
+        prefixLen = len;
+    }
+    return true;
+}
+
+template <class Value>
+bool
+CompactIpTrie<Value>::insert(const std::string &cidr, const mapped_type &v)
+{
+    unsigned char addr[16];
+    unsigned int addrLen, prefixLen;
+    if (!parse(cidr, addr, addrLen, prefixLen))
+        return false;
+    return insert(addr, addrLen, prefixLen, v);
+}
+
+template <class Value>
+const typename CompactIpTrie<Value>::mapped_type *
+CompactIpTrie<Value>::longestMatch(const std::string &address)
+{
+    unsigned char addr[16];
+    unsigned int addrLen, prefixLen;
+    if (!parse(address, addr, addrLen, prefixLen))
+        return nullptr;
+    return longestMatch(addr, addrLen);
+}
+
+#endif /* SQUID_COMPACTIPTRIE_H_ */
@@ -0,0 +1,303 @@
+#ifndef SQUID_COMPACTLOUDSTRIE_H_
+#define SQUID_COMPACTLOUDSTRIE_H_
+
+#include "CompactStaticTrie.h"
+#include "CompactTrie.h"
+#include "CompactValueArray.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <utility>
+#include <vector>
+
+/** Private auxiliary class for CompactLoudsTrie.
+ *
+ * Append-only bit vector with constant-time rank and fast select.
+ * DO NOT USE or try to access it in any other context.
+ */
+class LoudsBitVector
+{
+public:
+    LoudsBitVector() : nbits(0) {}
+
+    void push_back(bool bit) {
+        if (nbits % 64 == 0)
+            words.push_back(0);
+        if (bit)
+            words.back() |= (uint64_t(1) << (nbits % 64));
+        ++nbits;
+    }
+
+    bool operator[](size_t pos) const {
+        return (words[pos / 64] >> (pos % 64)) & 1;
+    }
+
+    size_t size() const { return nbits; }
+
+    /// build the rank and select directories; call once after the last push_back
+    void freeze() {
+        rankDir.clear();
+        select0Dir.clear();
+        uint64_t count = 0;
+        uint64_t zeros = 0;
+        for (size_t w = 0; w < words.size(); ++w) {
+            if (w % wordsPerBlock == 0)
+                rankDir.push_back(count);
+            const unsigned int validBits = (w == words.size() - 1 && nbits % 64) ? nbits % 64 : 64;
+            const unsigned int pc = __builtin_popcountll(words[w]);
+            // sample the block holding every select0Sample-th zero
+            const unsigned int z = validBits - pc;
+            while (select0Dir.size() * select0Sample < zeros + z) {
+                select0Dir.push_back(w / wordsPerBlock);
+            }
+            count += pc;
+            zeros += z;
+        }
+        rankDir.push_back(count);
+    }
+
+    /// number of set bits in [0, pos)
+    size_t rank1(size_t pos) const {
+        const size_t w = pos / 64;
+        size_t r = rankDir[w / wordsPerBlock];
+        for (size_t i = w - w % wordsPerBlock; i < w; ++i)
+            r += __builtin_popcountll(words[i]);
+        if (pos % 64)
+            r += __builtin_popcountll(words[w] & ((uint64_t(1) << (pos % 64)) - 1));
+        return r;
+    }
+
+    /// number of clear bits in [0, pos)
+    size_t rank0(size_t pos) const { return pos - rank1(pos); }
+
+    /// position of the k-th clear bit, counting from 0
+    size_t select0(size_t k) const {
+        // locate the block, starting from the sampled one
+        size_t block = select0Dir[k / select0Sample];
+        while (block + 1 < rankDir.size() - 1 &&
+                (block + 1) * wordsPerBlock * 64 - rankDir[block + 1] <= k)
+            ++block;
+        size_t remaining = k - (block * wordsPerBlock * 64 - rankDir[block]);
+        size_t w = block * wordsPerBlock;
+        for (;; ++w) {
+            const unsigned int z = 64 - __builtin_popcountll(words[w]);
+            if (remaining < z)
+                break;
+            remaining -= z;
+        }
+        uint64_t inv = ~words[w];
+        for (; remaining; --remaining)
+            inv &= inv - 1;
+        return w * 64 + __builtin_ctzll(inv);
+    }
+
+    /// memory used, in bytes
+    size_t bytes() const {
+        return (words.capacity() + rankDir.capacity()) * sizeof(uint64_t) +
+               select0Dir.capacity() * sizeof(uint32_t);
+    }
+
+    void shrink_to_fit() {
+        words.shrink_to_fit();
+    }
+
+private:
+    static const unsigned int wordsPerBlock = 8; // 512-bit rank blocks
+    static const unsigned int select0Sample = 512;
+
+    std::vector<uint64_t> words;
+    std::vector<uint64_t> rankDir; // set bits before each block
+    std::vector<uint32_t> select0Dir; // block holding each sampled zero
+    size_t nbits;
+};
+
+/** Static succinct trie
+ *
+ * Read-only counterpart of CompactTrie meant for very large key sets.
+ * The trie topology is stored as a LOUDS (Level-Order Unary Degree
+ * Sequence) bit vector, navigated with rank/select; edge labels are kept
+ * in a byte array in level order, and a second bit vector marks the nodes
+ * holding data. Apart from the mapped values, this costs about 11 bits
+ * plus some rank/select directory overhead per node.
+ *
+ * Keys themselves are not stored, so lookups return a pointer to the
+ * mapped value rather than an iterator. Key characters are
+ * treated as unsigned bytes.
+ *
+ * \sa http://en.wikipedia.org/wiki/Succinct_data_structure
+ */
+template <class Key, class Value>
+class CompactLoudsTrie
+{
+public:
+    typedef Key key_type;
+    typedef Value mapped_type;
+    typedef std::pair<key_type, mapped_type> value_type;
+
+    /// build from the contents of a CompactTrie
+    explicit CompactLoudsTrie(CompactTrie<key_type, mapped_type> &t);
+
+    /** build from a sequence of value_type
+     *
+     * Input doesn't need to be sorted; if a key is repeated,
+     * the last occurrence wins.
+     */
+    template <class InputIterator>
+    CompactLoudsTrie(InputIterator begin, const InputIterator &end) {
+        std::vector<CompactStaticTrie::key_entry> keys;
+        std::vector<mapped_type> input;
+        CompactStaticTrie::sortKeys(begin, end, keys, input);
+        build(keys, input);
+    }
+
+    /// check for key or prefix presence, see CompactTrie::has()
+    bool has(const key_type &k, bool const prefix = false) const {
+        return (prefix ? prefixFind(k) : find(k)) != nullptr;
+    }
+
+    /** key lookup
+     *
+     * \return pointer to the value mapped to key k, or nullptr if not found
+     */
+    const mapped_type *find(const key_type &k) const {
+        return value(CompactStaticTrie::lowFind(*this, size_t(0), k.begin(), k.end(), false, false, 0));
+    }
+
+    /** prefix lookup
+     *
+     * \return pointer to the value mapped to the shortest prefix of k,
+     *   or nullptr if no prefix of k is stored
+     */
+    const mapped_type *prefixFind(const key_type &k) const {
+        return value(CompactStaticTrie::lowFind(*this, size_t(0), k.begin(), k.end(), true, false, 0));
+    }
+
+    /** constrained prefix lookup
+     *
+     * Same semantics as CompactTrie::prefixFind(key, suffixChar)
+     * \return pointer to the mapped value or nullptr if not found
+     */
+    const mapped_type *prefixFind(const key_type &k, int suffixChar) const {
+        return value(CompactStaticTrie::lowFind(*this, size_t(0), k.begin(), k.end(), true, true, suffixChar));
+    }
+
+    /// number of stored keys
+    size_t size() const { return values.size(); }
+
+    /// empty-trie test
+    bool empty() const { return values.empty(); }
+
+    /// number of trie nodes, including the root
+    size_t nodes() const { return labels.size() + 1; }
+
+    /// memory used by the trie structure, excluding the mapped values
+    size_t structureBytes() const {
+        return louds.bytes() + terminal.bytes() + labels.capacity();
+    }
+
+private:
+    friend class CompactStaticTrie;
+
+    static const size_t npos = static_cast<size_t>(-1);
+
+    /// build from sorted, unique keys, see CompactStaticTrie::sortKeys()
+    void build(const std::vector<CompactStaticTrie::key_entry> &keys, const std::vector<mapped_type> &input);
+
+    /// number of the child of node reached via label c, or npos
+    size_t child(size_t node, unsigned char c) const;
+
+    bool isTerminal(size_t node) const { return terminal[node]; }
+
+    const mapped_type *value(size_t node) const {
+        if (node == npos)
+            return nullptr;
+        return &values[terminal.rank1(node)];
+    }
+
+    /* LOUDS encoding: "10" for a virtual super-root, then for each node
+     * in level order as many 1s as it has children, followed by a 0.
+     * Node n (root is 0) is the n+1-th 1 bit, its children are described
+     * between the n+1-th and the n+2-th 0 bit.
+     */
+    LoudsBitVector louds;
+    LoudsBitVector terminal; // one bit per node, set if node has data
+    std::vector<unsigned char> labels; // label of the edge leading to node n is labels[n-1]
+    CompactValueArray<mapped_type> values; // in level order of the terminal nodes
+};
+
+template <class Key, class Value>
+CompactLoudsTrie<Key,Value>::CompactLoudsTrie(CompactTrie<key_type, mapped_type> &t)
+{
+    std::vector<CompactStaticTrie::key_entry> keys;
+    std::vector<mapped_type> input;
+    CompactStaticTrie::sortKeys(t, keys, input);
+    build(keys, input);
+}
+
+template <class Key, class Value>
+void
+CompactLoudsTrie<Key,Value>::build(const std::vector<CompactStaticTrie::key_entry> &keys, const std::vector<mapped_type> &input)
+{
+    louds.push_back(true);
+    louds.push_back(false);
+
+    // breadth-first: each node is the range of keys sharing a depth-long prefix
+    struct Range {
+        size_t begin, end, depth;
+    };
+    std::deque<Range> queue;
+    queue.push_back(Range { 0, keys.size(), 0 });
+    while (!queue.empty()) {
+        Range r = queue.front();
+        queue.pop_front();
+        // sorted input: a key ending at this node comes first
+        const bool haveData = (r.begin < r.end && keys[r.begin].first.size() == r.depth);
+        terminal.push_back(haveData);
+        if (haveData) {
+            values.push_back(input[keys[r.begin].second]);
+            ++r.begin;
+        }
+        while (r.begin < r.end) {
+            const char c = keys[r.begin].first[r.depth];
+            size_t e = r.begin + 1;
+            while (e < r.end && keys[e].first[r.depth] == c)
+                ++e;
+            louds.push_back(true);
+            labels.push_back(c);
+            queue.push_back(Range { r.begin, e, r.depth + 1 });
+            r.begin = e;
+        }
+        louds.push_back(false);
+    }
+    louds.freeze();
+    terminal.freeze();
+    louds.shrink_to_fit();
+    terminal.shrink_to_fit();
+    labels.shrink_to_fit();
+    values.shrink_to_fit();
+}
+
+template <class Key, class Value>
+size_t
+CompactLoudsTrie<Key,Value>::child(size_t node, unsigned char c) const
+{
+    // children block of node lies between its node+1-th and node+2-th 0
+    const size_t start = louds.select0(node) + 1;
+    size_t stop = start;
+    while (louds[stop])
+        ++stop;
+    if (stop == start)
+        return npos;
+    // children are numbered consecutively; bits before start hold
+    // one 1 for the super-root edge plus one per preceding child
+    const size_t first = start - node - 1; // == rank1(start), node+1 zeros precede start
+    const auto lbegin = labels.begin() + (first - 1);
+    const auto lend = lbegin + (stop - start);
+    const auto found = std::lower_bound(lbegin, lend, c);
+    if (found == lend || *found != c)
+        return npos;
+    return first + (found - lbegin);
+}
+
+#endif /* SQUID_COMPACTLOUDSTRIE_H_ */
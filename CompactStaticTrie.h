@@ -0,0 +1,119 @@
+#ifndef SQUID_COMPACTSTATICTRIE_H_
+#define SQUID_COMPACTSTATICTRIE_H_
+
+#include "CompactTrie.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+/** Private auxiliary class for the static CompactTrie variants.
+ *
+ * Build and lookup steps shared by CompactLoudsTrie and CompactDawg,
+ * which only differ in how they store their nodes.
+ *
+ * DO NOT USE or try to access it in any other context.
+ */
+class CompactStaticTrie
+{
+public:
+    /// a key as a string of unsigned bytes, with the position of its value
+    typedef std::pair<std::string, size_t> key_entry;
+
+    /** normalise a sequence of (key, value) pairs
+     *
+     * Fills keys with the input keys as unsigned bytes, sorted, and values
+     * with the input values, so that the value of keys[n] is
+     * values[keys[n].second]. If a key is repeated, the last occurrence wins.
+     */
+    template <class InputIterator, class Value>
+    static void sortKeys(InputIterator begin, const InputIterator &end, std::vector<key_entry> &keys, std::vector<Value> &values);
+
+    /// normalise the contents of a CompactTrie, see sortKeys(begin, end, ...)
+    template <class Key, class Value>
+    static void sortKeys(CompactTrie<Key, Value> &t, std::vector<key_entry> &keys, std::vector<Value> &values);
+
+    /** key lookup from node root, mirroring CompactArrayTrieNode::iterativeLowFind
+     *
+     * Trie must provide child(node, unsigned char) returning Trie::npos
+     * if there is no such child, and isTerminal(node).
+     * \return the node holding the matched key, or Trie::npos
+     */
+    template <class Trie, class Index, class InputIterator>
+    static Index lowFind(const Trie &t, Index root, InputIterator i, const InputIterator &end, bool const prefix, bool const haveTrailChar, int const trailchar);
+};
+
+template <class InputIterator, class Value>
+void
+CompactStaticTrie::sortKeys(InputIterator begin, const InputIterator &end, std::vector<key_entry> &keys, std::vector<Value> &values)
+{
+    keys.clear();
+    values.clear();
+    for (; begin != end; ++begin) {
+        std::string bytes;
+        for (auto c = begin->first.begin(); c != begin->first.end(); ++c)
+            bytes.push_back(static_cast<unsigned char>(*c));
+        keys.push_back(key_entry(bytes, values.size()));
+        values.push_back(begin->second);
+    }
+    std::stable_sort(keys.begin(), keys.end(),
+    [](const key_entry &a, const key_entry &b) {
+        return a.first < b.first;
+    });
+    // keep the last occurrence of repeated keys
+    std::vector<key_entry> unique;
+    for (auto k = keys.begin(); k != keys.end(); ++k) {
+        if (!unique.empty() && unique.back().first == k->first)
+            unique.back() = *k;
+        else
+            unique.push_back(*k);
+    }
+    keys.swap(unique);
+}
+
+template <class Key, class Value>
+void
+CompactStaticTrie::sortKeys(CompactTrie<Key, Value> &t, std::vector<key_entry> &keys, std::vector<Value> &values)
+{
+    std::vector<typename CompactTrie<Key, Value>::value_type> v;
+    v.reserve(t.contents().size());
+    for (auto i = t.contents().begin(); i != t.contents().end(); ++i)
+        v.push_back(**i);
+    sortKeys(v.begin(), v.end(), keys, values);
+}
+
+template <class Trie, class Index, class InputIterator>
+Index
+CompactStaticTrie::lowFind(const Trie &t, Index root, InputIterator i, const InputIterator &end, bool const prefix, bool const haveTrailChar, int const trailchar)
+{
+    const unsigned char trail = static_cast<unsigned char>(trailchar);
+    Index n = root;
+    while (i != end) {
+        const unsigned char character = static_cast<unsigned char>(*i);
+
+        if (prefix && !haveTrailChar && t.isTerminal(n))
+            return n;
+
+        const Index c = t.child(n, character);
+
+        if (prefix && haveTrailChar && character == trail && c != Trie::npos && t.isTerminal(c))
+            return c;
+
+        if (c == Trie::npos)
+            return Trie::npos;
+        n = c;
+        ++i;
+    }
+    if (t.isTerminal(n))
+        return n;
+
+    if (prefix && haveTrailChar) {
+        const Index c = t.child(n, trail);
+        if (c != Trie::npos && t.isTerminal(c))
+            return c;
+    }
+    return Trie::npos;
+}
+
+#endif /* SQUID_COMPACTSTATICTRIE_H_ */
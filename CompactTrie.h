@@ -2,9 +2,12 @@
 #define SQUID_COMPACTTRIE_H_
 
 #include "CompactArrayTrieNode.h"
+#include "CompactTriePrefilter.h"
 
 #include <cassert>
+#include <cstdint>
 #include <algorithm>
+#include <memory>
 
 template <class Key, class Value>
 class CompactTrieIterator;
@@ -36,7 +39,7 @@ private:
     typedef CompactArrayTrieNode<key_type, mapped_type> node_type;
 
 public:
-    CompactTrie() {}
+    CompactTrie() : modCount(0) {}
     virtual ~CompactTrie() {}
 
     /** add a new item to the Trie
@@ -45,7 +48,42 @@ public:
      */
     bool insert(const key_type &k, mapped_type v) {
         contentsCache.clear();
-        return root.insert(k,v);
+        ++modCount;
+        const bool rv = root.insert(k,v);
+        if (prefilter) {
+            prefilterAdd(k);
+            if (prefilter->full())
+                rebuildPrefilter(prefilter->suffixChar(), prefilter->falsePositiveRate(), 2 * prefilter->capacity());
+        }
+        return rv;
+    }
+
+    /** modification counter
+     *
+     * Incremented on every change to the contents of the Trie; lookup
+     * caches can use it to detect that their cached results are stale.
+     */
+    uint64_t generation() const {
+        return modCount;
+    }
+
+    /** enable a probabilistic prefilter in front of lookups
+     *
+     * Once enabled, exact lookups and prefix lookups constrained by
+     * suffixChar can often answer "not found" without walking the Trie,
+     * at the cost of one cache line probe per suffixChar-terminated
+     * prefix of the key. The filter is kept up to date on insert and
+     * grows as needed to keep its false positive rate close to the
+     * requested one. Lookups passing the key by iterators then need
+     * forward iterators, as the key is scanned twice.
+     */
+    void enablePrefilter(int suffixChar, double falsePositiveRate = 0.01) {
+        rebuildPrefilter(suffixChar, falsePositiveRate, 0);
+    }
+
+    /// drop the prefilter, if any
+    void disablePrefilter() {
+        prefilter.reset();
     }
 
     /** Check for key or prefix presence
@@ -64,6 +102,8 @@ public:
     bool has(InputIterator begin, const InputIterator &end, bool const prefix = false) {
         if (prefix)
             return (root.findPrefix(begin, end) != nullptr);
+        if (prefilter && prefilterExcludes(begin, end))
+            return false;
         return (root.find(begin, end) != nullptr);
     }
 
@@ -78,6 +118,8 @@ public:
     /// key lookup, passing the key by begin and end iterators
     template <class InputIterator>
     iterator find(InputIterator begin, const InputIterator& end) {
+        if (prefilter && prefilterExcludes(begin, end))
+            return this->end();
         node_type *f=root.find(begin,end);
         if (f == nullptr)
             return this->end();
@@ -121,6 +163,8 @@ public:
     /// constrained prefix lookup, passing the key by begin and end iterators
     template <class InputIterator>
     iterator prefixFind(InputIterator begin, const InputIterator& end, int suffixChar) {
+        if (prefilter && prefilter->suffixChar() == suffixChar && prefilterExcludes(begin, end, suffixChar))
+            return this->end();
         node_type *f=root.findPrefix(begin, end, suffixChar);
         if (f == nullptr)
             return this->end();
@@ -154,10 +198,92 @@ public:
     //TODO: add delete
 
 private:
+    /// add key and its suffixChar-terminated prefixes to the prefilter
+    void prefilterAdd(const key_type &k);
+    void rebuildPrefilter(int suffixChar, double falsePositiveRate, size_t capacity);
+    /// \return true if the prefilter proves the key is not stored
+    template <class InputIterator>
+    bool prefilterExcludes(InputIterator begin, const InputIterator &end) const;
+    /// \return true if the prefilter proves no constrained prefix of the key is stored
+    template <class InputIterator>
+    bool prefilterExcludes(InputIterator begin, const InputIterator &end, int suffixChar) const;
+
     node_type root;
     std::vector<iterator> contentsCache; // valid if !empty() || root.empty()
+    uint64_t modCount;
+    std::unique_ptr<CompactTriePrefilter> prefilter; // optional
 };
 
+template <class Key, class Value>
+void
+CompactTrie<Key,Value>::prefilterAdd(const key_type &k)
+{
+    const int suffixChar = prefilter->suffixChar();
+    uint64_t h = CompactTriePrefilter::hashStart();
+    for (auto i = k.begin(); i != k.end(); ++i) {
+        const int character = *i;
+        h = CompactTriePrefilter::hashStep(h, character);
+        if (character == suffixChar)
+            prefilter->addBoundary(h);
+    }
+    prefilter->addKey(h);
+}
+
+template <class Key, class Value>
+void
+CompactTrie<Key,Value>::rebuildPrefilter(int suffixChar, double falsePositiveRate, size_t capacity)
+{
+    const std::vector<iterator> &c = contents();
+    if (!capacity) {
+        // size for the current contents, with room to grow
+        for (auto i = c.begin(); i != c.end(); ++i) {
+            ++capacity;
+            const key_type &k = (*i)->first;
+            capacity += std::count(k.begin(), k.end(), suffixChar);
+        }
+        capacity = std::max<size_t>(2 * capacity, 1024);
+    }
+    prefilter.reset(new CompactTriePrefilter(suffixChar, capacity, falsePositiveRate));
+    for (auto i = c.begin(); i != c.end(); ++i)
+        prefilterAdd((*i)->first);
+}
+
+template <class Key, class Value>
+template <class InputIterator>
+bool
+CompactTrie<Key,Value>::prefilterExcludes(InputIterator i, const InputIterator &end) const
+{
+    uint64_t h = CompactTriePrefilter::hashStart();
+    for (; i != end; ++i)
+        h = CompactTriePrefilter::hashStep(h, *i);
+    return !prefilter->mayHaveKey(h);
+}
+
+template <class Key, class Value>
+template <class InputIterator>
+bool
+CompactTrie<Key,Value>::prefilterExcludes(InputIterator i, const InputIterator &end, int suffixChar) const
+{
+    // candidates, as in CompactArrayTrieNode::iterativeLowFind: every prefix
+    // of the key ending with suffixChar, the key, and the key plus suffixChar.
+    // A stored key matching any candidate past a given suffixChar-terminated
+    // prefix would have added that prefix as a boundary.
+    uint64_t h = CompactTriePrefilter::hashStart();
+    for (; i != end; ++i) {
+        const int character = *i;
+        h = CompactTriePrefilter::hashStep(h, character);
+        if (character == suffixChar) {
+            if (prefilter->mayHaveKey(h))
+                return false;
+            if (!prefilter->mayHaveBoundary(h))
+                return true;
+        }
+    }
+    if (prefilter->mayHaveKey(h))
+        return false;
+    return !prefilter->mayHaveKey(CompactTriePrefilter::hashStep(h, suffixChar));
+}
+
 template <class Key, class Value>
 const std::vector<typename CompactTrie<Key,Value>::iterator> &
 CompactTrie<Key,Value>::contents()
@@ -0,0 +1,203 @@
+#ifndef SQUID_COMPACTTRIECACHE_H_
+#define SQUID_COMPACTTRIECACHE_H_
+
+#include "CompactTrie.h"
+
+#include <cstdint>
+#include <vector>
+
+/** Small set-associative lookup cache in front of a CompactTrie
+ *
+ * Remembers the outcome of recent find() and prefixFind() calls, both
+ * positive (an iterator to the stored entry) and negative (end()), so that
+ * repeated lookups of hot keys do not walk the trie again.
+ * Keys are identified by a FNV-1a hash; the full key is kept alongside to
+ * rule out collisions, so results are always exact.
+ *
+ * Each cached entry is tagged with the trie generation it was computed at;
+ * any modification of the trie (insert) bumps the generation and thus
+ * invalidates all cached results at once.
+ *
+ * The cache is not thread-safe and is meant to be kept per-thread, e.g.
+ * \code
+ * thread_local CompactTrieCache<std::string, int> cache(trie);
+ * \endcode
+ */
+template <class Key, class Value>
+class CompactTrieCache
+{
+public:
+    typedef CompactTrie<Key, Value> trie_type;
+    typedef typename trie_type::key_type key_type;
+    typedef typename trie_type::iterator iterator;
+
+    /// number of entries in each set
+    static const unsigned int ways = 4;
+    /// largest supported number of sets
+    static const unsigned int maxSets = 1u << 31;
+
+    /** constructor
+     *
+     * \param t the trie to front; it must outlive the cache
+     * \param sets number of sets in the cache, rounded up to a power of two
+     *   and capped at maxSets
+     */
+    explicit CompactTrieCache(trie_type &t, unsigned int sets = 64);
+
+    /// cached equivalent of CompactTrie::find(k)
+    iterator find(const key_type &k) {
+        return lookup(k, ExactLookup, 0);
+    }
+
+    /// cached equivalent of CompactTrie::prefixFind(k)
+    iterator prefixFind(const key_type &k) {
+        return lookup(k, PrefixLookup, 0);
+    }
+
+    /// cached equivalent of CompactTrie::prefixFind(k, suffixChar)
+    iterator prefixFind(const key_type &k, int suffixChar) {
+        return lookup(k, SuffixPrefixLookup, suffixChar);
+    }
+
+    /// cached equivalent of CompactTrie::has(k, prefix)
+    bool has(const key_type &k, bool const prefix = false) {
+        return (prefix ? prefixFind(k) : find(k)) != trie.end();
+    }
+
+    /// drop all cached results
+    void clear();
+
+    /// lookups answered from the cache
+    uint64_t hits() const { return hitCount; }
+    /// lookups which had to be forwarded to the trie
+    uint64_t misses() const { return missCount; }
+    /// fraction of lookups answered from the cache, 0 if no lookups were made
+    double hitRate() const {
+        const uint64_t total = hitCount + missCount;
+        return total ? static_cast<double>(hitCount) / total : 0.0;
+    }
+    /// zero the hits and misses counters
+    void resetStats() { hitCount = missCount = 0; }
+
+private:
+    enum LookupKind { ExactLookup, PrefixLookup, SuffixPrefixLookup };
+
+    struct Entry {
+        Entry() : hash(0), generation(0), suffixChar(0), kind(ExactLookup), valid(false) {}
+        key_type key;
+        iterator result;
+        uint64_t hash;
+        uint64_t generation;
+        int suffixChar;
+        LookupKind kind;
+        bool valid;
+    };
+
+    iterator lookup(const key_type &k, LookupKind kind, int suffixChar);
+    static uint64_t hashKey(const key_type &k, LookupKind kind, int suffixChar);
+
+    trie_type &trie;
+    std::vector<Entry> entries; // sets*ways, each set is contiguous
+    std::vector<unsigned char> victim; // per-set round-robin replacement cursor
+    unsigned int setMask;
+    uint64_t hitCount;
+    uint64_t missCount;
+
+    /// not implemented
+    CompactTrieCache(const CompactTrieCache &);
+    /// not implemented
+    CompactTrieCache& operator =(CompactTrieCache const &);
+};
+
+template <class Key, class Value>
+CompactTrieCache<Key,Value>::CompactTrieCache(trie_type &t, unsigned int sets) :
+        trie(t),
+        setMask(0),
+        hitCount(0),
+        missCount(0)
+{
+    if (sets > maxSets)
+        sets = maxSets;
+    unsigned int s = 1;
+    while (s < sets)
+        s <<= 1;
+    setMask = s - 1;
+    entries.resize(s * ways);
+    victim.resize(s, 0);
+}
+
+template <class Key, class Value>
+void
+CompactTrieCache<Key,Value>::clear()
+{
+    for (auto e = entries.begin(); e != entries.end(); ++e)
+        e->valid = false;
+}
+
+template <class Key, class Value>
+uint64_t
+CompactTrieCache<Key,Value>::hashKey(const key_type &k, LookupKind kind, int suffixChar)
+{
+    // 64-bit FNV-1a
+    uint64_t h = 14695981039346656037ULL;
+    for (auto i = k.begin(); i != k.end(); ++i) {
+        h ^= static_cast<unsigned char>(*i);
+        h *= 1099511628211ULL;
+    }
+    h ^= static_cast<uint64_t>(kind) << 8 | static_cast<unsigned char>(suffixChar);
+    h *= 1099511628211ULL;
+    return h;
+}
+
+template <class Key, class Value>
+typename CompactTrieCache<Key,Value>::iterator
+CompactTrieCache<Key,Value>::lookup(const key_type &k, LookupKind kind, int suffixChar)
+{
+    const uint64_t h = hashKey(k, kind, suffixChar);
+    const unsigned int set = static_cast<unsigned int>(h >> 32) & setMask;
+    Entry *const first = &entries[set * ways];
+    const uint64_t gen = trie.generation();
+
+    for (unsigned int w = 0; w < ways; ++w) {
+        const Entry &e = first[w];
+        if (e.valid && e.hash == h && e.generation == gen && e.kind == kind &&
+                e.suffixChar == suffixChar && e.key == k) {
+            ++hitCount;
+            return e.result;
+        }
+    }
+
+    ++missCount;
+    iterator rv;
+    switch (kind) {
+    case ExactLookup:
+        rv = trie.find(k);
+        break;
+    case PrefixLookup:
+        rv = trie.prefixFind(k);
+        break;
+    case SuffixPrefixLookup:
+        rv = trie.prefixFind(k, suffixChar);
+        break;
+    }
+
+    // prefer reusing an invalid or stale way over evicting a live one
+    unsigned int w = 0;
+    while (w < ways && first[w].valid && first[w].generation == gen)
+        ++w;
+    if (w == ways) {
+        w = victim[set];
+        victim[set] = (w + 1) % ways;
+    }
+    Entry &e = first[w];
+    e.key = k;
+    e.result = rv;
+    e.hash = h;
+    e.generation = gen;
+    e.suffixChar = suffixChar;
+    e.kind = kind;
+    e.valid = true;
+    return rv;
+}
+
+#endif /* SQUID_COMPACTTRIECACHE_H_ */
@@ -0,0 +1,133 @@
+#ifndef SQUID_COMPACTTRIEPREFILTER_H_
+#define SQUID_COMPACTTRIEPREFILTER_H_
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/** Private auxiliary class for CompactTrie.
+ *
+ * Blocked Bloom filter recording, for each key stored in the Trie, the key
+ * itself and its "boundary" prefixes (those ending with the suffixChar the
+ * filter is configured for). All bits for an entry live in the same
+ * 64-byte block, so each probe touches a single cache line.
+ * Entries are identified by their hash, computed incrementally with
+ * hashStart() and hashStep() so that all prefixes of a key can be probed
+ * in a single pass.
+ *
+ * DO NOT USE or try to access it in any other context.
+ */
+class CompactTriePrefilter
+{
+public:
+    /** constructor
+     *
+     * \param suffixChar the character ending boundary prefixes
+     * \param capacity number of entries (keys plus boundaries) the filter is sized for
+     * \param falsePositiveRate target false positive rate at capacity
+     */
+    CompactTriePrefilter(int suffixChar, size_t capacity, double falsePositiveRate) :
+            suffix(suffixChar),
+            maxEntries(capacity ? capacity : 1),
+            fpRate(falsePositiveRate),
+            entries(0)
+    {
+        if (!(fpRate > 0.0 && fpRate < 1.0))
+            fpRate = 0.01;
+        const double ln2 = std::log(2.0);
+        const double bits = maxEntries * -std::log(fpRate) / (ln2 * ln2);
+        nblocks = static_cast<size_t>(std::ceil(bits / blockBits));
+        if (!nblocks)
+            nblocks = 1;
+        nhashes = static_cast<unsigned int>(std::lround(bits / maxEntries * ln2));
+        if (nhashes < 1)
+            nhashes = 1;
+        // over-allocate so that blocks can be aligned to cache lines
+        storage.resize(nblocks * blockWords + blockWords - 1, 0);
+        const uintptr_t addr = reinterpret_cast<uintptr_t>(storage.data());
+        blocks = storage.data() + (((blockBytes - addr % blockBytes) % blockBytes) / sizeof(uint64_t));
+    }
+
+    static uint64_t hashStart() {
+        return 14695981039346656037ULL; // 64-bit FNV-1a offset basis
+    }
+    static uint64_t hashStep(uint64_t h, int character) {
+        h ^= static_cast<unsigned int>(character);
+        return h * 1099511628211ULL;
+    }
+
+    void addKey(uint64_t h) { add(h, keySalt); }
+    void addBoundary(uint64_t h) { add(h, boundarySalt); }
+    bool mayHaveKey(uint64_t h) const { return test(h, keySalt); }
+    bool mayHaveBoundary(uint64_t h) const { return test(h, boundarySalt); }
+
+    int suffixChar() const { return suffix; }
+    double falsePositiveRate() const { return fpRate; }
+    size_t capacity() const { return maxEntries; }
+    /// true once more entries than the filter was sized for have been added
+    bool full() const { return entries > maxEntries; }
+
+private:
+    static const unsigned int blockBytes = 64;
+    static const unsigned int blockWords = blockBytes / sizeof(uint64_t);
+    static const unsigned int blockBits = blockBytes * 8;
+    static const uint64_t keySalt = 0x9e3779b97f4a7c15ULL;
+    static const uint64_t boundarySalt = 0xc2b2ae3d27d4eb4fULL;
+
+    /// murmur3 finalizer
+    static uint64_t mix(uint64_t h) {
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        return h;
+    }
+
+    /// first word of the block for entry hash h
+    size_t block(uint64_t h) const {
+        // key and boundary entries for the same prefix share a block
+        const uint64_t m = mix(h);
+        return static_cast<size_t>((m >> 32) * nblocks >> 32) * blockWords;
+    }
+
+    void add(uint64_t h, uint64_t salt) {
+        uint64_t *b = blocks + block(h);
+        const uint64_t m = mix(h ^ salt);
+        const uint32_t h1 = m, h2 = (m >> 32) | 1;
+        for (unsigned int i = 0; i < nhashes; ++i) {
+            const unsigned int bit = (h1 + i * h2) % blockBits;
+            b[bit / 64] |= uint64_t(1) << (bit % 64);
+        }
+        ++entries;
+    }
+
+    bool test(uint64_t h, uint64_t salt) const {
+        const uint64_t *b = blocks + block(h);
+        const uint64_t m = mix(h ^ salt);
+        const uint32_t h1 = m, h2 = (m >> 32) | 1;
+        for (unsigned int i = 0; i < nhashes; ++i) {
+            const unsigned int bit = (h1 + i * h2) % blockBits;
+            if (!(b[bit / 64] & (uint64_t(1) << (bit % 64))))
+                return false;
+        }
+        return true;
+    }
+
+    int suffix;
+    size_t maxEntries;
+    double fpRate;
+    size_t entries;
+    size_t nblocks;
+    unsigned int nhashes;
+    std::vector<uint64_t> storage;
+    uint64_t *blocks; // cache-line aligned, into storage
+
+    /// not implemented
+    CompactTriePrefilter(const CompactTriePrefilter &);
+    /// not implemented
+    CompactTriePrefilter& operator =(CompactTriePrefilter const &);
+};
+
+#endif /* SQUID_COMPACTTRIEPREFILTER_H_ */
@@ -0,0 +1,40 @@
+#ifndef SQUID_COMPACTVALUEARRAY_H_
+#define SQUID_COMPACTVALUEARRAY_H_
+
+#include <vector>
+
+/** Private auxiliary class for the static CompactTrie variants.
+ *
+ * Append-only array of mapped values, addressed by index. Unlike a plain
+ * std::vector<Value> it can hand out pointers to its elements for any
+ * Value, bool included.
+ *
+ * DO NOT USE or try to access it in any other context.
+ */
+template <class Value>
+class CompactValueArray
+{
+public:
+    typedef Value mapped_type;
+
+    void push_back(const mapped_type &v) {
+        items.push_back(Item(v));
+    }
+
+    const mapped_type &operator[](size_t i) const {
+        return items[i].value;
+    }
+
+    size_t size() const { return items.size(); }
+    bool empty() const { return items.empty(); }
+    void shrink_to_fit() { items.shrink_to_fit(); }
+
+private:
+    struct Item {
+        explicit Item(const mapped_type &v) : value(v) {}
+        mapped_type value;
+    };
+    std::vector<Item> items;
+};
+
+#endif /* SQUID_COMPACTVALUEARRAY_H_ */
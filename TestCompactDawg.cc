@@ -0,0 +1,140 @@
+#include "TestCompactDawg.h"
+#include "CompactDawg.h"
+
+#include <cppunit/BriefTestProgressListener.h>
+#include <cppunit/TextTestProgressListener.h>
+#include <cppunit/CompilerOutputter.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/TestResult.h>
+#include <cppunit/TestResultCollector.h>
+#include <cppunit/TestRunner.h>
+
+typedef CompactTrie<std::string, int> CT;
+typedef CompactDawg<std::string, int> DT;
+
+void
+TestCompactDawg::testMinimize()
+{
+    CT ct;
+    {
+        DT empty(ct);
+        CPPUNIT_ASSERT(empty.nodes() == 1);
+        CPPUNIT_ASSERT(!empty.has(""));
+    }
+
+    // "tap", "top", "taps", "tops": the "p", "ps" tails are shared
+    ct.insert("tap",1);
+    ct.insert("top",1);
+    ct.insert("taps",1);
+    ct.insert("tops",1);
+    DT dt(ct);
+    CPPUNIT_ASSERT(dt.trieNodes() == 8);
+    CPPUNIT_ASSERT(dt.nodes() == 5);
+    CPPUNIT_ASSERT(dt.edges() == 5);
+    CPPUNIT_ASSERT(dt.distinctValues() == 1);
+}
+
+void
+TestCompactDawg::testSharedNode()
+{
+    // "xa.com" and "ya.com" reach the same "a.com" subtree through
+    // parents "x" and "y", which differ in their own values
+    CT ct;
+    ct.insert("x",2);
+    ct.insert("y",3);
+    ct.insert("xa.com",1);
+    ct.insert("ya.com",1);
+    ct.insert("xa.com.",4);
+    ct.insert("ya.com.",4);
+    DT dt(ct);
+    CPPUNIT_ASSERT(dt.trieNodes() == 15);
+    CPPUNIT_ASSERT(dt.nodes() == 9); // root, x, y, and the shared "a.com." chain
+
+    CPPUNIT_ASSERT_EQUAL(1, *dt.find("xa.com"));
+    CPPUNIT_ASSERT_EQUAL(1, *dt.find("ya.com"));
+    CPPUNIT_ASSERT_EQUAL(4, *dt.find("ya.com."));
+    CPPUNIT_ASSERT_EQUAL(2, *dt.find("x"));
+    CPPUNIT_ASSERT_EQUAL(3, *dt.find("y"));
+    CPPUNIT_ASSERT(dt.find("za.com") == nullptr);
+    CPPUNIT_ASSERT(dt.find("a.com") == nullptr);
+
+    // the shortest prefix depends on the path taken into the shared node
+    CPPUNIT_ASSERT_EQUAL(2, *dt.prefixFind("xa.com"));
+    CPPUNIT_ASSERT_EQUAL(3, *dt.prefixFind("ya.com"));
+    CPPUNIT_ASSERT_EQUAL(1, *dt.prefixFind("xa.com", '.'));
+    CPPUNIT_ASSERT_EQUAL(1, *dt.prefixFind("ya.co", 'm'));
+    CPPUNIT_ASSERT_EQUAL(4, *dt.prefixFind("ya.com.www", '.'));
+    CPPUNIT_ASSERT(dt.prefixFind("ya.org", '.') == nullptr);
+}
+
+void
+TestCompactDawg::testNoFalseMerge()
+{
+    // "a" and "c" hold the same value but have different children:
+    // only the "b" and "d" leaves, identical, are merged
+    CT ct;
+    ct.insert("a",1);
+    ct.insert("ab",5);
+    ct.insert("c",1);
+    ct.insert("cd",5);
+    DT dt(ct);
+    CPPUNIT_ASSERT(dt.trieNodes() == 5);
+    CPPUNIT_ASSERT(dt.nodes() == 4);
+    CPPUNIT_ASSERT_EQUAL(1, *dt.find("a"));
+    CPPUNIT_ASSERT_EQUAL(1, *dt.find("c"));
+    CPPUNIT_ASSERT_EQUAL(5, *dt.find("ab"));
+    CPPUNIT_ASSERT_EQUAL(5, *dt.find("cd"));
+    CPPUNIT_ASSERT(dt.find("ad") == nullptr);
+    CPPUNIT_ASSERT(dt.find("cb") == nullptr);
+}
+
+void
+TestCompactDawg::testValues()
+{
+    // identical tails with different values must not be merged
+    CT ct;
+    ct.insert("a/index.html",1);
+    ct.insert("b/index.html",2);
+    ct.insert("c/index.html",1);
+    DT dt(ct);
+    CPPUNIT_ASSERT_EQUAL(1, *dt.find("a/index.html"));
+    CPPUNIT_ASSERT_EQUAL(2, *dt.find("b/index.html"));
+    CPPUNIT_ASSERT_EQUAL(1, *dt.find("c/index.html"));
+    CPPUNIT_ASSERT(dt.distinctValues() == 2);
+    // root, plus two 12-node chains for "?/index.html"
+    CPPUNIT_ASSERT(dt.nodes() == 25);
+    CPPUNIT_ASSERT(dt.trieNodes() == 37);
+}
+
+/*** boilerplate starts here ***/
+
+CPPUNIT_TEST_SUITE_REGISTRATION( TestCompactDawg );
+
+int
+main (int argc, char ** argv)
+{
+    // Create the event manager and test controller
+    CPPUNIT_NS::TestResult controller;
+
+    // Add a listener that colllects test result
+    CPPUNIT_NS::TestResultCollector result;
+    controller.addListener( &result );
+
+    // Add a listener that print dots as test run.
+    // use BriefTestProgressListener to get names of each test
+    // even when they pass.
+    CPPUNIT_NS::TextTestProgressListener progress;
+    controller.addListener( &progress );
+
+    // Add the top suite to the test runner
+    CPPUNIT_NS::TestRunner runner;
+    runner.addTest( CPPUNIT_NS::TestFactoryRegistry::getRegistry().makeTest() );
+    runner.run( controller );
+
+    // Print test in a compiler compatible format.
+    CPPUNIT_NS::CompilerOutputter outputter( &result, std::cerr );
+    outputter.write();
+
+    return result.wasSuccessful() ? 0 : 1;
+}
+
@@ -0,0 +1,25 @@
+#ifndef SQUID_TESTCOMPACTDAWG_H_
+#define SQUID_TESTCOMPACTDAWG_H_
+
+#include <cppunit/extensions/HelperMacros.h>
+
+/**
+ *
+ */
+class TestCompactDawg  : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE( TestCompactDawg );
+    CPPUNIT_TEST( testMinimize );
+    CPPUNIT_TEST( testSharedNode );
+    CPPUNIT_TEST( testNoFalseMerge );
+    CPPUNIT_TEST( testValues );
+    CPPUNIT_TEST_SUITE_END();
+
+protected:
+    void testMinimize();
+    void testSharedNode();
+    void testNoFalseMerge();
+    void testValues();
+};
+
+#endif /* SQUID_TESTCOMPACTDAWG_H_ */
@@ -0,0 +1,163 @@
+#include "TestCompactIpTrie.h"
+#include "CompactIpTrie.h"
+
+#include <cppunit/BriefTestProgressListener.h>
+#include <cppunit/TextTestProgressListener.h>
+#include <cppunit/CompilerOutputter.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/TestResult.h>
+#include <cppunit/TestResultCollector.h>
+#include <cppunit/TestRunner.h>
+
+#include <cstdlib>
+
+typedef CompactIpTrie<int> IT;
+
+void
+TestCompactIpTrie::testInsert()
+{
+    IT it;
+    CPPUNIT_ASSERT(it.empty());
+    CPPUNIT_ASSERT_EQUAL(true, it.insert("10.0.0.0/8", 1));
+    CPPUNIT_ASSERT_EQUAL(true, it.insert("2001:db8::/32", 2));
+    CPPUNIT_ASSERT_EQUAL(true, it.insert("192.0.2.1", 3)); // host prefix
+    CPPUNIT_ASSERT_EQUAL(false, it.insert("10.0.0.0/33", 4));
+    CPPUNIT_ASSERT_EQUAL(false, it.insert("not an address", 4));
+    const unsigned char addr[4] = { 10, 0, 0, 0 };
+    CPPUNIT_ASSERT_EQUAL(false, it.insert(addr, 5, 8, 4)); // bad family
+    CPPUNIT_ASSERT(!it.empty());
+}
+
+void
+TestCompactIpTrie::testLongestMatch4()
+{
+    IT it;
+    CPPUNIT_ASSERT(it.longestMatch("10.1.2.3") == nullptr);
+
+    it.insert("10.0.0.0/8", 1);
+    it.insert("10.1.0.0/16", 2);
+    it.insert("10.1.2.0/23", 3);
+    it.insert("10.1.2.128/25", 4);
+    it.insert("10.1.2.129/32", 5);
+
+    CPPUNIT_ASSERT_EQUAL(1, *it.longestMatch("10.200.0.1"));
+    CPPUNIT_ASSERT_EQUAL(2, *it.longestMatch("10.1.200.1"));
+    CPPUNIT_ASSERT_EQUAL(3, *it.longestMatch("10.1.3.1"));
+    CPPUNIT_ASSERT_EQUAL(3, *it.longestMatch("10.1.2.1"));
+    CPPUNIT_ASSERT_EQUAL(4, *it.longestMatch("10.1.2.130"));
+    CPPUNIT_ASSERT_EQUAL(5, *it.longestMatch("10.1.2.129"));
+    CPPUNIT_ASSERT(it.longestMatch("11.0.0.1") == nullptr);
+
+    // a shorter prefix inserted later must not shadow longer ones
+    it.insert("10.1.2.0/24", 6);
+    CPPUNIT_ASSERT_EQUAL(6, *it.longestMatch("10.1.2.1"));
+    CPPUNIT_ASSERT_EQUAL(3, *it.longestMatch("10.1.3.1"));
+    CPPUNIT_ASSERT_EQUAL(4, *it.longestMatch("10.1.2.130"));
+
+    // replacing an existing prefix; host bits are ignored
+    it.insert("10.1.3.7/23", 7);
+    CPPUNIT_ASSERT_EQUAL(7, *it.longestMatch("10.1.3.1"));
+
+    // default route
+    it.insert("0.0.0.0/0", 8);
+    CPPUNIT_ASSERT_EQUAL(8, *it.longestMatch("11.0.0.1"));
+
+    // IPv6 lookups don't see IPv4 prefixes
+    CPPUNIT_ASSERT(it.longestMatch("::ffff:10.1.2.3") == nullptr);
+}
+
+void
+TestCompactIpTrie::testLongestMatch6()
+{
+    IT it;
+    it.insert("2001:db8::/32", 1);
+    it.insert("2001:db8:1::/48", 2);
+    it.insert("2001:db8:1:2::/63", 3);
+    it.insert("2001:db8:1:2::1/128", 4);
+
+    CPPUNIT_ASSERT_EQUAL(1, *it.longestMatch("2001:db8:ffff::1"));
+    CPPUNIT_ASSERT_EQUAL(2, *it.longestMatch("2001:db8:1:ffff::1"));
+    CPPUNIT_ASSERT_EQUAL(3, *it.longestMatch("2001:db8:1:3::1"));
+    CPPUNIT_ASSERT_EQUAL(4, *it.longestMatch("2001:db8:1:2::1"));
+    CPPUNIT_ASSERT_EQUAL(3, *it.longestMatch("2001:db8:1:2::2"));
+    CPPUNIT_ASSERT(it.longestMatch("2001:db9::1") == nullptr);
+    CPPUNIT_ASSERT(it.longestMatch("10.0.0.1") == nullptr);
+}
+
+void
+TestCompactIpTrie::testRandom()
+{
+    // compare against a linear scan, on prefixes clustered enough to nest
+    struct Prefix {
+        unsigned char addr[16];
+        unsigned int len;
+    };
+    srand(1);
+    for (unsigned int addrLen = 4; addrLen <= 16; addrLen += 12) {
+        IT it;
+        std::vector<Prefix> prefixes(500);
+        for (size_t i = 0; i < prefixes.size(); ++i) {
+            for (unsigned int b = 0; b < addrLen; ++b)
+                prefixes[i].addr[b] = rand() % 3;
+            prefixes[i].len = rand() % (addrLen * 8 + 1);
+            it.insert(prefixes[i].addr, addrLen, prefixes[i].len, i);
+        }
+        for (int l = 0; l < 2000; ++l) {
+            unsigned char addr[16];
+            for (unsigned int b = 0; b < addrLen; ++b)
+                addr[b] = rand() % 3;
+            int expected = -1;
+            unsigned int expectedLen = 0;
+            for (size_t i = 0; i < prefixes.size(); ++i) {
+                const Prefix &p = prefixes[i];
+                bool covers = true;
+                for (unsigned int bit = 0; covers && bit < p.len; ++bit) {
+                    const unsigned char mask = 0x80 >> (bit % 8);
+                    covers = (p.addr[bit / 8] & mask) == (addr[bit / 8] & mask);
+                }
+                if (covers && (expected < 0 || p.len >= expectedLen)) {
+                    expected = i;
+                    expectedLen = p.len;
+                }
+            }
+            const int *found = it.longestMatch(addr, addrLen);
+            if (expected < 0)
+                CPPUNIT_ASSERT(found == nullptr);
+            else
+                CPPUNIT_ASSERT(found != nullptr && *found == expected);
+        }
+    }
+}
+
+/*** boilerplate starts here ***/
+
+CPPUNIT_TEST_SUITE_REGISTRATION( TestCompactIpTrie );
+
+int
+main (int argc, char ** argv)
+{
+    // Create the event manager and test controller
+    CPPUNIT_NS::TestResult controller;
+
+    // Add a listener that colllects test result
+    CPPUNIT_NS::TestResultCollector result;
+    controller.addListener( &result );
+
+    // Add a listener that print dots as test run.
+    // use BriefTestProgressListener to get names of each test
+    // even when they pass.
+    CPPUNIT_NS::TextTestProgressListener progress;
+    controller.addListener( &progress );
+
+    // Add the top suite to the test runner
+    CPPUNIT_NS::TestRunner runner;
+    runner.addTest( CPPUNIT_NS::TestFactoryRegistry::getRegistry().makeTest() );
+    runner.run( controller );
+
+    // Print test in a compiler compatible format.
+    CPPUNIT_NS::CompilerOutputter outputter( &result, std::cerr );
+    outputter.write();
+
+    return result.wasSuccessful() ? 0 : 1;
+}
+
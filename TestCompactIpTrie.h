@@ -0,0 +1,25 @@
+#ifndef SQUID_TESTCOMPACTIPTRIE_H_
+#define SQUID_TESTCOMPACTIPTRIE_H_
+
+#include <cppunit/extensions/HelperMacros.h>
+
+/**
+ *
+ */
+class TestCompactIpTrie  : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE( TestCompactIpTrie );
+    CPPUNIT_TEST( testInsert );
+    CPPUNIT_TEST( testLongestMatch4 );
+    CPPUNIT_TEST( testLongestMatch6 );
+    CPPUNIT_TEST( testRandom );
+    CPPUNIT_TEST_SUITE_END();
+
+protected:
+    void testInsert();
+    void testLongestMatch4();
+    void testLongestMatch6();
+    void testRandom();
+};
+
+#endif /* SQUID_TESTCOMPACTIPTRIE_H_ */
@@ -0,0 +1,135 @@
+#include "TestCompactLoudsTrie.h"
+#include "CompactLoudsTrie.h"
+
+#include <cppunit/BriefTestProgressListener.h>
+#include <cppunit/TextTestProgressListener.h>
+#include <cppunit/CompilerOutputter.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/TestResult.h>
+#include <cppunit/TestResultCollector.h>
+#include <cppunit/TestRunner.h>
+
+typedef CompactTrie<std::string, int> CT;
+typedef CompactLoudsTrie<std::string, int> LT;
+
+void
+TestCompactLoudsTrie::testInsert()
+{
+    std::vector<LT::value_type> v;
+    v.push_back(LT::value_type("foo", 1));
+    v.push_back(LT::value_type("bar", 2));
+    v.push_back(LT::value_type("foo", 3)); // repeated key, last one wins
+    LT lt(v.begin(), v.end());
+    CPPUNIT_ASSERT(lt.size() == 2);
+    CPPUNIT_ASSERT(lt.nodes() == 7);
+    CPPUNIT_ASSERT_EQUAL(3, *lt.find("foo"));
+
+    // high-bit key characters
+    v.push_back(LT::value_type("\xff\x80", 4));
+    v.push_back(LT::value_type("\x7f", 5));
+    LT hb(v.begin(), v.end());
+    CPPUNIT_ASSERT_EQUAL(4, *hb.find("\xff\x80"));
+    CPPUNIT_ASSERT_EQUAL(5, *hb.find("\x7f"));
+    CPPUNIT_ASSERT(hb.find("\xff") == nullptr);
+
+    LT empty(v.end(), v.end());
+    CPPUNIT_ASSERT(empty.empty());
+    CPPUNIT_ASSERT(!empty.has("foo"));
+    CPPUNIT_ASSERT(empty.prefixFind("foo", '.') == nullptr);
+}
+
+void
+TestCompactLoudsTrie::testFind()
+{
+    CT ct;
+    ct.insert("foo",1);
+    ct.insert("bar",2);
+    ct.insert("",3);
+    LT lt(ct);
+    CPPUNIT_ASSERT(lt.size() == 3);
+    CPPUNIT_ASSERT_EQUAL(1, *lt.find("foo"));
+    CPPUNIT_ASSERT_EQUAL(2, *lt.find("bar"));
+    CPPUNIT_ASSERT_EQUAL(3, *lt.find(""));
+    CPPUNIT_ASSERT(lt.find("fo") == nullptr);
+    CPPUNIT_ASSERT(lt.find("fooo") == nullptr);
+    CPPUNIT_ASSERT(lt.find("gazonk") == nullptr);
+    CPPUNIT_ASSERT(lt.has("foo"));
+    CPPUNIT_ASSERT(!lt.has("gazonk"));
+}
+
+void
+TestCompactLoudsTrie::testPrefixFind()
+{
+    // same cases as TestCompactTrie::testFind
+    CT ct;
+    ct.insert("foo",1);
+    ct.insert("bar",2);
+    ct.insert("foo.",3);
+    ct.insert("baz.", 4);
+    LT lt(ct);
+
+    CPPUNIT_ASSERT(lt.prefixFind("foo") != nullptr);
+    CPPUNIT_ASSERT(lt.prefixFind("fooo") != nullptr);
+    CPPUNIT_ASSERT(lt.prefixFind("go") == nullptr);
+    CPPUNIT_ASSERT(lt.has("fooo", true));
+
+    CPPUNIT_ASSERT(lt.prefixFind("foo.", '.') != nullptr);
+    CPPUNIT_ASSERT_EQUAL(1, *lt.prefixFind("foo", '.'));
+    CPPUNIT_ASSERT(lt.prefixFind("foooo", '.') == nullptr);
+    CPPUNIT_ASSERT_EQUAL(3, *lt.prefixFind("foo.bar", '.'));
+    CPPUNIT_ASSERT_EQUAL(4, *lt.prefixFind("baz.bar", '.'));
+    CPPUNIT_ASSERT_EQUAL(4, *lt.prefixFind("baz", '.'));
+    CPPUNIT_ASSERT(lt.prefixFind("baz.www", '.') != nullptr);
+    CPPUNIT_ASSERT(lt.prefixFind("bazz.www", '.') == nullptr);
+}
+
+void
+TestCompactLoudsTrie::testLarge()
+{
+    // enough nodes to exercise multiple rank and select blocks
+    CT ct;
+    for (int i = 0; i < 20000; ++i)
+        ct.insert("moc.elpmaxe." + std::to_string(i * 7) + ".", i);
+    LT lt(ct);
+    CPPUNIT_ASSERT(lt.size() == 20000);
+    for (int i = 0; i < 20000; ++i) {
+        const std::string k = "moc.elpmaxe." + std::to_string(i * 7) + ".";
+        CPPUNIT_ASSERT(lt.find(k) != nullptr && *lt.find(k) == i);
+        CPPUNIT_ASSERT(lt.find(k + "x") == nullptr);
+        CPPUNIT_ASSERT(lt.prefixFind(k + "www", '.') != nullptr);
+        CPPUNIT_ASSERT(lt.prefixFind("moc.elpmaxe." + std::to_string(i * 7 + 1) + ".www", '.') == nullptr);
+    }
+}
+
+/*** boilerplate starts here ***/
+
+CPPUNIT_TEST_SUITE_REGISTRATION( TestCompactLoudsTrie );
+
+int
+main (int argc, char ** argv)
+{
+    // Create the event manager and test controller
+    CPPUNIT_NS::TestResult controller;
+
+    // Add a listener that colllects test result
+    CPPUNIT_NS::TestResultCollector result;
+    controller.addListener( &result );
+
+    // Add a listener that print dots as test run.
+    // use BriefTestProgressListener to get names of each test
+    // even when they pass.
+    CPPUNIT_NS::TextTestProgressListener progress;
+    controller.addListener( &progress );
+
+    // Add the top suite to the test runner
+    CPPUNIT_NS::TestRunner runner;
+    runner.addTest( CPPUNIT_NS::TestFactoryRegistry::getRegistry().makeTest() );
+    runner.run( controller );
+
+    // Print test in a compiler compatible format.
+    CPPUNIT_NS::CompilerOutputter outputter( &result, std::cerr );
+    outputter.write();
+
+    return result.wasSuccessful() ? 0 : 1;
+}
+
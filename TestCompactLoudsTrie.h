@@ -0,0 +1,25 @@
+#ifndef SQUID_TESTCOMPACTLOUDSTRIE_H_
+#define SQUID_TESTCOMPACTLOUDSTRIE_H_
+
+#include <cppunit/extensions/HelperMacros.h>
+
+/**
+ *
+ */
+class TestCompactLoudsTrie  : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE( TestCompactLoudsTrie );
+    CPPUNIT_TEST( testInsert );
+    CPPUNIT_TEST( testFind );
+    CPPUNIT_TEST( testPrefixFind );
+    CPPUNIT_TEST( testLarge );
+    CPPUNIT_TEST_SUITE_END();
+
+protected:
+    void testInsert();
+    void testFind();
+    void testPrefixFind();
+    void testLarge();
+};
+
+#endif /* SQUID_TESTCOMPACTLOUDSTRIE_H_ */
@@ -0,0 +1,145 @@
+/* Longest-prefix-match benchmark: CompactIpTrie vs CompactTrie
+ *
+ * Builds a routing-table-sized set of random IPv4 and IPv6 prefixes with
+ * a realistic length distribution and times lookups of random addresses.
+ * CompactTrie has no notion of bit-length keys, so prefixes are stored
+ * there as strings of '0' and '1' characters, one per bit; note that its
+ * prefixFind() returns the shortest, not the longest, matching prefix.
+ * Memory is the heap growth while building each structure.
+ *
+ * usage: benchCompactIpTrie [ipv4-prefixes [ipv6-prefixes [lookups]]]
+ * A prefix count of 0 skips that address family.
+ */
+#include "CompactIpTrie.h"
+#include "CompactTrie.h"
+#include "benchHeapCounter.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Prefix {
+    unsigned char addr[16];
+    unsigned int len;
+};
+
+std::mt19937 rng(42);
+
+unsigned int
+randomLength(unsigned int addrLen)
+{
+    const unsigned int r = rng() % 100;
+    if (addrLen == 4) // roughly the shape of a full BGP table
+        return r < 60 ? 24 : (r < 99 ? 16 + rng() % 8 : 8 + rng() % 8);
+    return r < 50 ? 48 : (r < 90 ? 29 + rng() % 19 : 19 + rng() % 10);
+}
+
+void
+randomAddress(unsigned char *addr, unsigned int addrLen)
+{
+    for (unsigned int i = 0; i < addrLen; ++i)
+        addr[i] = rng();
+}
+
+std::string
+bitString(const unsigned char *addr, unsigned int bits)
+{
+    std::string s(bits, '0');
+    for (unsigned int i = 0; i < bits; ++i)
+        if (addr[i / 8] & (0x80 >> (i % 8)))
+            s[i] = '1';
+    return s;
+}
+
+double
+elapsed(std::chrono::steady_clock::time_point since)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - since).count();
+}
+
+void
+run(unsigned int addrLen, unsigned int nPrefixes, unsigned int nLookups)
+{
+    std::vector<Prefix> prefixes(nPrefixes);
+    for (auto p = prefixes.begin(); p != prefixes.end(); ++p) {
+        randomAddress(p->addr, addrLen);
+        p->len = randomLength(addrLen);
+    }
+
+    // half of the lookups hit an inserted prefix, half are random
+    std::vector<Prefix> lookups(nLookups);
+    for (unsigned int i = 0; i < nLookups; ++i) {
+        Prefix &l = lookups[i];
+        randomAddress(l.addr, addrLen);
+        if (i % 2) {
+            const Prefix &p = prefixes[rng() % nPrefixes];
+            for (unsigned int b = 0; b < p.len; ++b) {
+                const unsigned char mask = 0x80 >> (b % 8);
+                l.addr[b / 8] = (l.addr[b / 8] & ~mask) | (p.addr[b / 8] & mask);
+            }
+        }
+    }
+    std::vector<std::string> lookupKeys;
+    lookupKeys.reserve(nLookups);
+    for (auto l = lookups.begin(); l != lookups.end(); ++l)
+        lookupKeys.push_back(bitString(l->addr, addrLen * 8));
+
+    size_t heapBefore = heapInUse;
+    auto t = std::chrono::steady_clock::now();
+    CompactIpTrie<int> ipTrie;
+    for (unsigned int i = 0; i < nPrefixes; ++i)
+        ipTrie.insert(prefixes[i].addr, addrLen, prefixes[i].len, i);
+    ipTrie.compile();
+    const double ipBuild = elapsed(t);
+    const size_t ipBytes = heapInUse - heapBefore;
+
+    heapBefore = heapInUse;
+    t = std::chrono::steady_clock::now();
+    CompactTrie<std::string, int> byteTrie;
+    for (unsigned int i = 0; i < nPrefixes; ++i)
+        byteTrie.insert(bitString(prefixes[i].addr, prefixes[i].len), i);
+    const double byteBuild = elapsed(t);
+    const size_t byteBytes = heapInUse - heapBefore;
+
+    unsigned long ipFound = 0;
+    t = std::chrono::steady_clock::now();
+    for (auto l = lookups.begin(); l != lookups.end(); ++l)
+        ipFound += (ipTrie.longestMatch(l->addr, addrLen) != nullptr);
+    const double ipLookup = elapsed(t);
+
+    unsigned long byteFound = 0;
+    t = std::chrono::steady_clock::now();
+    for (auto k = lookupKeys.begin(); k != lookupKeys.end(); ++k)
+        byteFound += (byteTrie.prefixFind(*k) != byteTrie.end());
+    const double byteLookup = elapsed(t);
+
+    printf("IPv%u, %u prefixes, %u lookups\n", addrLen == 4 ? 4 : 6, nPrefixes, nLookups);
+    printf("  %-13s build %7.3fs  %8.1f ns/lookup  %7.1f bytes/prefix  %lu found\n",
+           "CompactIpTrie", ipBuild, ipLookup * 1e9 / nLookups, double(ipBytes) / nPrefixes, ipFound);
+    printf("  %-13s build %7.3fs  %8.1f ns/lookup  %7.1f bytes/prefix  %lu found\n",
+           "CompactTrie", byteBuild, byteLookup * 1e9 / nLookups, double(byteBytes) / nPrefixes, byteFound);
+}
+
+} // namespace
+
+int
+main(int argc, char **argv)
+{
+    const unsigned int n4 = argc > 1 ? countArg(argv[1]) : 900000;
+    const unsigned int n6 = argc > 2 ? countArg(argv[2]) : 200000;
+    const unsigned int nLookups = argc > 3 ? countArg(argv[3]) : 2000000;
+    if (!nLookups) {
+        fprintf(stderr, "lookups must be positive\n");
+        return 1;
+    }
+    if (n4)
+        run(4, n4, nLookups);
+    if (n6)
+        run(16, n6, nLookups);
+    return 0;
+}
@@ -0,0 +1,108 @@
+/* Space/time benchmark: CompactLoudsTrie vs CompactTrie
+ *
+ * Builds a set of synthetic reversed domain names, stores them in both
+ * tries and reports memory use and the cost of constrained prefix lookups
+ * (the blocklist use case: prefixFind(host, '.')).
+ * CompactTrie memory is measured as the heap growth while building it.
+ *
+ * usage: benchCompactLoudsTrie [keys [lookups]]
+ */
+#include "CompactLoudsTrie.h"
+#include "CompactTrie.h"
+#include "benchHeapCounter.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::mt19937 rng(42);
+
+std::string
+randomLabel()
+{
+    static const char alphabet[] = "abcdefghijklmnopqrstuvwxyz0123456789-";
+    std::string s;
+    const unsigned int len = 3 + rng() % 10;
+    for (unsigned int i = 0; i < len; ++i)
+        s.push_back(alphabet[rng() % (sizeof(alphabet) - 1)]);
+    return s;
+}
+
+/// a reversed domain name, e.g. "moc.elpmaxe.www."
+std::string
+randomDomain()
+{
+    static const char *tlds[] = { "moc.", "ten.", "gro.", "ed.", "ku.oc.", "ti.", "nc.", "ur." };
+    std::string s = tlds[rng() % (sizeof(tlds) / sizeof(tlds[0]))];
+    const unsigned int labels = 1 + (rng() % 4 == 0);
+    for (unsigned int i = 0; i < labels; ++i)
+        s += randomLabel() + ".";
+    return s;
+}
+
+double
+elapsed(std::chrono::steady_clock::time_point since)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - since).count();
+}
+
+} // namespace
+
+int
+main(int argc, char **argv)
+{
+    const unsigned int nKeys = argc > 1 ? countArg(argv[1]) : 1000000;
+    const unsigned int nLookups = argc > 2 ? countArg(argv[2]) : 2000000;
+    if (!nKeys || !nLookups) {
+        fprintf(stderr, "keys and lookups must be positive\n");
+        return 1;
+    }
+
+    std::vector<std::string> keys;
+    keys.reserve(nKeys);
+    for (unsigned int i = 0; i < nKeys; ++i)
+        keys.push_back(randomDomain());
+
+    // half of the lookups are hosts under a stored domain, half are misses
+    std::vector<std::string> lookups;
+    lookups.reserve(nLookups);
+    for (unsigned int i = 0; i < nLookups; ++i)
+        lookups.push_back(i % 2 ? keys[rng() % nKeys] + "www" : randomDomain() + "www");
+
+    const size_t heapBefore = heapInUse;
+    auto t = std::chrono::steady_clock::now();
+    CompactTrie<std::string, bool> ct;
+    for (auto k = keys.begin(); k != keys.end(); ++k)
+        ct.insert(*k, true);
+    const double ctBuild = elapsed(t);
+    const size_t ctBytes = heapInUse - heapBefore;
+
+    t = std::chrono::steady_clock::now();
+    CompactLoudsTrie<std::string, bool> lt(ct);
+    const double ltBuild = elapsed(t);
+    const size_t ltBytes = lt.structureBytes() + lt.size() * sizeof(bool);
+
+    unsigned long ctFound = 0;
+    t = std::chrono::steady_clock::now();
+    for (auto l = lookups.begin(); l != lookups.end(); ++l)
+        ctFound += (ct.prefixFind(*l, '.') != ct.end());
+    const double ctLookup = elapsed(t);
+
+    unsigned long ltFound = 0;
+    t = std::chrono::steady_clock::now();
+    for (auto l = lookups.begin(); l != lookups.end(); ++l)
+        ltFound += (lt.prefixFind(*l, '.') != nullptr);
+    const double ltLookup = elapsed(t);
+
+    printf("%zu keys, %zu nodes, %u lookups\n", lt.size(), lt.nodes(), nLookups);
+    printf("  %-16s %10zu bytes  %6.1f bits/node  build %7.3fs  %7.1f ns/lookup  %lu found\n",
+           "CompactTrie", ctBytes, ctBytes * 8.0 / lt.nodes(), ctBuild, ctLookup * 1e9 / nLookups, ctFound);
+    printf("  %-16s %10zu bytes  %6.1f bits/node  build %7.3fs  %7.1f ns/lookup  %lu found\n",
+           "CompactLoudsTrie", ltBytes, ltBytes * 8.0 / lt.nodes(), ltBuild, ltLookup * 1e9 / nLookups, ltFound);
+    return 0;
+}
@@ -0,0 +1,76 @@
+#ifndef SQUID_BENCHHEAPCOUNTER_H_
+#define SQUID_BENCHHEAPCOUNTER_H_
+
+/* Shared helpers for the benchmark programs
+ *
+ * Portable heap usage accounting: replaces the global operator new and
+ * delete with versions keeping track of the number of bytes currently
+ * allocated. Also provides command line argument parsing.
+ * Include it from exactly one translation unit per program.
+ */
+
+#include <cerrno>
+#include <climits>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+/// bytes currently allocated through operator new
+size_t heapInUse = 0;
+
+// each block is prefixed with its size, padded to keep the payload aligned
+const size_t heapHeader = alignof(std::max_align_t);
+
+/// parse a non-negative count from the command line, exit on invalid input
+unsigned int
+countArg(const char *arg)
+{
+    char *end = nullptr;
+    errno = 0;
+    const unsigned long n = strtoul(arg, &end, 10);
+    if (end == arg || *end != '\0' || *arg == '-' || errno == ERANGE || n > UINT_MAX) {
+        fprintf(stderr, "invalid count: %s\n", arg);
+        exit(1);
+    }
+    return n;
+}
+
+} // namespace
+
+void *
+operator new(size_t n)
+{
+    char *p = static_cast<char *>(malloc(n + heapHeader));
+    if (!p)
+        throw std::bad_alloc();
+    *reinterpret_cast<size_t *>(p) = n;
+    heapInUse += n;
+    return p + heapHeader;
+}
+
+void
+operator delete(void *p) noexcept
+{
+    if (!p)
+        return;
+    char *block = static_cast<char *>(p) - heapHeader;
+    heapInUse -= *reinterpret_cast<size_t *>(block);
+    free(block);
+}
+
+void *
+operator new[](size_t n)
+{
+    return operator new(n);
+}
+
+void
+operator delete[](void *p) noexcept
+{
+    operator delete(p);
+}
+
+#endif /* SQUID_BENCHHEAPCOUNTER_H_ */
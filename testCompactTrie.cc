@@ -136,6 +136,82 @@ TestCompactTrie::testContents()
     CPPUNIT_ASSERT(ct.contents()[2]->first == "foo1");
 }
 
+void
+TestCompactTrie::testCache()
+{
+    CT ct;
+    ct.insert("moc.elpmaxe.",1);
+    CompactTrieCache<std::string, int> cache(ct, 4);
+
+    CPPUNIT_ASSERT(cache.prefixFind("moc.elpmaxe.www", '.') != ct.end());
+    CPPUNIT_ASSERT_EQUAL(cache.prefixFind("moc.elpmaxe.www", '.')->second, 1);
+    CPPUNIT_ASSERT(cache.hits() == 1);
+    CPPUNIT_ASSERT(cache.misses() == 1);
+
+    // negative results are cached too
+    CPPUNIT_ASSERT(cache.prefixFind("gro.elpmaxe.www", '.') == ct.end());
+    CPPUNIT_ASSERT(cache.prefixFind("gro.elpmaxe.www", '.') == ct.end());
+    CPPUNIT_ASSERT(cache.hits() == 2);
+
+    // same key, different lookup kind: not a hit
+    CPPUNIT_ASSERT(cache.find("moc.elpmaxe.www") == ct.end());
+    CPPUNIT_ASSERT(cache.misses() == 3);
+
+    // insert invalidates cached negative results
+    ct.insert("gro.elpmaxe.",2);
+    CPPUNIT_ASSERT(cache.prefixFind("gro.elpmaxe.www", '.') != ct.end());
+    CPPUNIT_ASSERT_EQUAL(cache.prefixFind("gro.elpmaxe.www", '.')->second, 2);
+
+    // more keys than fit in the cache: results must stay exact
+    for (int i = 0; i < 100; ++i) {
+        const std::string k = "moc.elpmaxe." + std::to_string(i);
+        CPPUNIT_ASSERT(cache.has(k, true));
+        CPPUNIT_ASSERT(!cache.has(k));
+    }
+    cache.resetStats();
+    CPPUNIT_ASSERT(cache.hitRate() == 0.0);
+}
+
+void
+TestCompactTrie::testPrefilter()
+{
+    CT ct;
+    ct.insert("foo",1);
+    ct.insert("bar",2);
+    ct.insert("foo.",3);
+    ct.insert("baz.", 4);
+    ct.enablePrefilter('.');
+
+    // same expectations as testFind
+    CPPUNIT_ASSERT(ct.find("foo") != ct.end());
+    CPPUNIT_ASSERT(ct.find("gazonk") == ct.end());
+    CPPUNIT_ASSERT(ct.has("bar"));
+    CPPUNIT_ASSERT(ct.has("fooo", true));
+    CPPUNIT_ASSERT(ct.prefixFind("foo.", '.') != ct.end());
+    CPPUNIT_ASSERT(ct.prefixFind("foo", '.') != ct.end());
+    CPPUNIT_ASSERT(ct.prefixFind("foooo", '.') == ct.end());
+    CPPUNIT_ASSERT(ct.prefixFind("foo.bar", '.') != ct.end());
+    CPPUNIT_ASSERT(ct.prefixFind("baz.bar", '.') != ct.end());
+    CPPUNIT_ASSERT(ct.prefixFind("baz", '.') != ct.end());
+    CPPUNIT_ASSERT(ct.prefixFind("bazz.www", '.') == ct.end());
+    // other suffix chars bypass the filter
+    CPPUNIT_ASSERT(ct.prefixFind("foo", '%') != ct.end());
+    CPPUNIT_ASSERT(ct.prefixFind("foo%bar", '%') == ct.end());
+
+    // stays consistent with insert, including past its initial capacity
+    for (int i = 0; i < 5000; ++i)
+        ct.insert("moc.elpmaxe." + std::to_string(i) + ".", i);
+    for (int i = 0; i < 5000; ++i) {
+        const std::string k = "moc.elpmaxe." + std::to_string(i) + ".";
+        CPPUNIT_ASSERT(ct.has(k));
+        CPPUNIT_ASSERT(ct.prefixFind(k + "www", '.') != ct.end());
+        CPPUNIT_ASSERT(ct.prefixFind(k.substr(0, k.size() - 1), '.') != ct.end());
+    }
+    CPPUNIT_ASSERT(ct.prefixFind("moc.elpmaxe.www", '.') == ct.end());
+
+    ct.disablePrefilter();
+    CPPUNIT_ASSERT(ct.has("foo"));
+}
 
 /*** boilerplate starts here ***/
 
@@ -2,6 +2,7 @@
 #define SQUID_TESTCOMPACTTRIE_H_
 
 #include "CompactTrie.h"
+#include "CompactTrieCache.h"
 
 #include <cppunit/extensions/HelperMacros.h>
 
@@ -16,6 +17,8 @@ class TestCompactTrie  : public CPPUNIT_NS::TestFixture
     CPPUNIT_TEST( testIterator );
     CPPUNIT_TEST( testEmpty );
     CPPUNIT_TEST( testContents );
+    CPPUNIT_TEST( testCache );
+    CPPUNIT_TEST( testPrefilter );
     //    CPPUNIT_TEST(  );
     CPPUNIT_TEST_SUITE_END();
 
@@ -25,6 +28,8 @@ protected:
     void testIterator();
     void testEmpty();
     void testContents();
+    void testCache();
+    void testPrefilter();
     //  void testWhatever();
 };
 